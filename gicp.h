@@ -0,0 +1,337 @@
+#pragma once
+
+#include <vtkIdList.h>
+#include <vtkMatrix4x4.h>
+#include <vtkNew.h>
+#include <vtkPoints.h>
+#include <vtkPolyData.h>
+#include <vtkSMPThreadLocal.h>
+#include <vtkSMPTools.h>
+#include <vtkSmartPointer.h>
+#include <vtkStaticPointLocator.h>
+
+#include <Eigen/Dense>
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * @brief 每个点的3x3协方差矩阵，按结构数组（SoA）方式存储。
+ *
+ * 协方差矩阵对称，只保存上三角的6个分量，每个分量一个连续数组，
+ * 下标与点云中点的下标一致。
+ */
+struct PointCovariances
+{
+    std::vector<double> xx, xy, xz, yy, yz, zz;
+
+    /**
+     * @brief 为 n 个点分配存储空间。
+     */
+    void resize(std::size_t n)
+    {
+        xx.resize(n);
+        xy.resize(n);
+        xz.resize(n);
+        yy.resize(n);
+        yz.resize(n);
+        zz.resize(n);
+    }
+
+    std::size_t size() const { return xx.size(); }
+
+    /**
+     * @brief 取出第 i 个点的协方差矩阵。
+     */
+    Eigen::Matrix3d get(std::size_t i) const
+    {
+        Eigen::Matrix3d c;
+        c << xx[i], xy[i], xz[i],
+            xy[i], yy[i], yz[i],
+            xz[i], yz[i], zz[i];
+        return c;
+    }
+
+    /**
+     * @brief 设置第 i 个点的协方差矩阵（只读取上三角部分）。
+     */
+    void set(std::size_t i, const Eigen::Matrix3d &c)
+    {
+        xx[i] = c(0, 0);
+        xy[i] = c(0, 1);
+        xz[i] = c(0, 2);
+        yy[i] = c(1, 1);
+        yz[i] = c(1, 2);
+        zz[i] = c(2, 2);
+    }
+};
+
+/**
+ * @brief 供 GICP 使用的点云：点、最近邻定位器以及每个点的协方差。
+ *
+ * 协方差和定位器只在 Prepare 时计算一次，之后同一个点云可以作为源或目标
+ * 反复参与配准，不需要重新计算。
+ */
+class GICPCloud
+{
+private:
+    vtkSmartPointer<vtkPoints> points;
+    vtkSmartPointer<vtkStaticPointLocator> locator;
+    PointCovariances covariances;
+
+    /**
+     * @brief 并行计算每个点的协方差，供 vtkSMPTools::For 调用。
+     */
+    struct CovarianceWorker
+    {
+        vtkPoints *Points;
+        vtkStaticPointLocator *Locator;
+        PointCovariances *Covariances;
+        int Neighbors;
+        double Epsilon;
+
+        void operator()(vtkIdType begin, vtkIdType end)
+        {
+            vtkNew<vtkIdList> ids;
+            std::vector<Eigen::Vector3d> neighborhood;
+            for (vtkIdType i = begin; i < end; ++i)
+            {
+                double p[3];
+                Points->GetPoint(i, p);
+                Locator->FindClosestNPoints(Neighbors, p, ids);
+
+                vtkIdType n = ids->GetNumberOfIds();
+                if (n < 3)
+                {
+                    Covariances->set(i, Eigen::Matrix3d::Identity());
+                    continue;
+                }
+
+                neighborhood.resize(n);
+                Eigen::Vector3d mean = Eigen::Vector3d::Zero();
+                for (vtkIdType j = 0; j < n; ++j)
+                {
+                    Points->GetPoint(ids->GetId(j), neighborhood[j].data());
+                    mean += neighborhood[j];
+                }
+                mean /= static_cast<double>(n);
+
+                Eigen::Matrix3d cov = Eigen::Matrix3d::Zero();
+                for (const auto &q : neighborhood)
+                {
+                    Eigen::Vector3d d = q - mean;
+                    cov += d * d.transpose();
+                }
+                cov /= static_cast<double>(n);
+
+                // 将特征值替换为 (eps, 1, 1)：沿法向的方差很小，切平面内各向同性，
+                // 即 GICP 的 plane-to-plane 形式，同时保证矩阵可逆
+                Eigen::SelfAdjointEigenSolver<Eigen::Matrix3d> solver(cov);
+                Eigen::Vector3d values(Epsilon, 1.0, 1.0);
+                Covariances->set(i, solver.eigenvectors() * values.asDiagonal() * solver.eigenvectors().transpose());
+            }
+        }
+    };
+
+public:
+    /**
+     * @brief 由点集构建定位器，并用 k 近邻并行计算每个点的协方差。
+     *
+     * @param polydata 输入点集。
+     * @param neighbors 估计协方差时使用的近邻点数（缺省值为20）。
+     * @param epsilon 法向方向的相对方差（缺省值为1e-3）。
+     */
+    void Prepare(vtkPolyData *polydata, int neighbors = 20, double epsilon = 1e-3)
+    {
+        points = polydata->GetPoints();
+        locator = vtkSmartPointer<vtkStaticPointLocator>::New();
+        locator->SetDataSet(polydata);
+        locator->BuildLocator();
+
+        vtkIdType n = points->GetNumberOfPoints();
+        covariances.resize(static_cast<std::size_t>(n));
+        CovarianceWorker worker{points, locator, &covariances, neighbors, epsilon};
+        vtkSMPTools::For(0, n, worker);
+    }
+
+    vtkPoints *GetPoints() const { return points; }
+    vtkStaticPointLocator *GetLocator() const { return locator; }
+    const PointCovariances &GetCovariances() const { return covariances; }
+};
+
+/**
+ * @brief 广义ICP（Generalized-ICP）配准。
+ *
+ * 每次迭代并行地为源点寻找目标中的最近点，以两点协方差之和的逆作为权重
+ * 累加 Gauss-Newton 法方程，再求解6自由度的刚体增量。相比点到点ICP，
+ * 在噪声较大的数据上每次迭代收敛得更快。
+ */
+class GICPRegistration
+{
+private:
+    int maximumNumberOfIterations = 50;
+    double maximumCorrespondenceDistance = 1.0;
+    double convergenceTolerance = 1e-6;
+    bool startByMatchingCentroids = false;
+    int numberOfIterations = 0;
+    double meanError = 0.0;
+
+    /**
+     * @brief 单个线程的法方程累加量。
+     */
+    struct NormalEquations
+    {
+        Eigen::Matrix<double, 6, 6> H = Eigen::Matrix<double, 6, 6>::Zero();
+        Eigen::Matrix<double, 6, 1> g = Eigen::Matrix<double, 6, 1>::Zero();
+        double error = 0.0;
+        std::size_t count = 0;
+    };
+
+    /**
+     * @brief 并行累加一次迭代的法方程，供 vtkSMPTools::For 调用。
+     */
+    struct GaussNewtonWorker
+    {
+        const GICPCloud *Source;
+        const GICPCloud *Target;
+        Eigen::Matrix3d R;
+        Eigen::Vector3d t;
+        double MaxDistance;
+        vtkSMPThreadLocal<NormalEquations> Local;
+        NormalEquations Result;
+
+        GaussNewtonWorker(const GICPCloud *source, const GICPCloud *target,
+                          const Eigen::Matrix3d &r, const Eigen::Vector3d &translation, double maxDistance)
+            : Source(source), Target(target), R(r), t(translation), MaxDistance(maxDistance) {}
+
+        void Initialize() { Local.Local() = NormalEquations(); }
+
+        void operator()(vtkIdType begin, vtkIdType end)
+        {
+            NormalEquations &eq = Local.Local();
+            vtkPoints *sourcePoints = Source->GetPoints();
+            vtkPoints *targetPoints = Target->GetPoints();
+            const PointCovariances &sourceCov = Source->GetCovariances();
+            const PointCovariances &targetCov = Target->GetCovariances();
+
+            for (vtkIdType i = begin; i < end; ++i)
+            {
+                Eigen::Vector3d a;
+                sourcePoints->GetPoint(i, a.data());
+                Eigen::Vector3d p = R * a + t;
+
+                double dist2;
+                vtkIdType j = Target->GetLocator()->FindClosestPointWithinRadius(MaxDistance, p.data(), dist2);
+                if (j < 0)
+                    continue;
+
+                Eigen::Vector3d b;
+                targetPoints->GetPoint(j, b.data());
+                Eigen::Vector3d e = p - b;
+
+                Eigen::Matrix3d C = targetCov.get(j) + R * sourceCov.get(i) * R.transpose();
+                Eigen::Matrix3d M = C.inverse();
+
+                // 左乘扰动 exp(xi) 下 e 对 (omega, v) 的雅可比：[-[p]x, I]
+                Eigen::Matrix<double, 3, 6> J;
+                J << 0.0, p.z(), -p.y(), 1.0, 0.0, 0.0,
+                    -p.z(), 0.0, p.x(), 0.0, 1.0, 0.0,
+                    p.y(), -p.x(), 0.0, 0.0, 0.0, 1.0;
+
+                Eigen::Matrix<double, 6, 3> JtM = J.transpose() * M;
+                eq.H += JtM * J;
+                eq.g += JtM * e;
+                eq.error += e.dot(M * e);
+                ++eq.count;
+            }
+        }
+
+        void Reduce()
+        {
+            Result = NormalEquations();
+            for (const auto &eq : Local)
+            {
+                Result.H += eq.H;
+                Result.g += eq.g;
+                Result.error += eq.error;
+                Result.count += eq.count;
+            }
+        }
+    };
+
+public:
+    void SetMaximumNumberOfIterations(int n) { maximumNumberOfIterations = n; }
+    void SetMaximumCorrespondenceDistance(double d) { maximumCorrespondenceDistance = d; }
+    void SetConvergenceTolerance(double tol) { convergenceTolerance = tol; }
+    void SetStartByMatchingCentroids(bool on) { startByMatchingCentroids = on; }
+    int GetNumberOfIterations() const { return numberOfIterations; }
+    double GetMeanError() const { return meanError; }
+
+    /**
+     * @brief 求解将源点云配准到目标点云的刚体变换。
+     *
+     * @param source 已调用 Prepare 的源点云。
+     * @param target 已调用 Prepare 的目标点云，可在多次配准间复用。
+     * @param matrix 输出的4x4变换矩阵。
+     */
+    void Register(const GICPCloud &source, const GICPCloud &target, vtkMatrix4x4 *matrix)
+    {
+        Eigen::Matrix3d R = Eigen::Matrix3d::Identity();
+        Eigen::Vector3d t = Eigen::Vector3d::Zero();
+        vtkIdType n = source.GetPoints()->GetNumberOfPoints();
+
+        if (startByMatchingCentroids)
+        {
+            Eigen::Vector3d sourceCenter = Eigen::Vector3d::Zero();
+            Eigen::Vector3d targetCenter = Eigen::Vector3d::Zero();
+            Eigen::Vector3d p;
+            for (vtkIdType i = 0; i < n; ++i)
+            {
+                source.GetPoints()->GetPoint(i, p.data());
+                sourceCenter += p;
+            }
+            vtkIdType m = target.GetPoints()->GetNumberOfPoints();
+            for (vtkIdType i = 0; i < m; ++i)
+            {
+                target.GetPoints()->GetPoint(i, p.data());
+                targetCenter += p;
+            }
+            if (n > 0 && m > 0)
+                t = targetCenter / static_cast<double>(m) - sourceCenter / static_cast<double>(n);
+        }
+
+        numberOfIterations = 0;
+        meanError = 0.0;
+        while (numberOfIterations < maximumNumberOfIterations)
+        {
+            // 每次迭代使用新的线程局部累加量，未参与本次计算的线程不会残留上一次的结果
+            GaussNewtonWorker worker(&source, &target, R, t, maximumCorrespondenceDistance);
+            vtkSMPTools::For(0, n, worker);
+            ++numberOfIterations;
+
+            const NormalEquations &eq = worker.Result;
+            if (eq.count < 6)
+                break;
+            meanError = eq.error / static_cast<double>(eq.count);
+
+            Eigen::Matrix<double, 6, 1> delta = eq.H.ldlt().solve(-eq.g);
+            Eigen::Vector3d omega = delta.head<3>();
+            Eigen::Matrix3d dR = Eigen::Matrix3d::Identity();
+            if (omega.norm() > 0.0)
+                dR = Eigen::AngleAxisd(omega.norm(), omega.normalized()).toRotationMatrix();
+            R = dR * R;
+            t = dR * t + delta.tail<3>();
+
+            if (delta.norm() < convergenceTolerance)
+                break;
+        }
+
+        matrix->Identity();
+        for (int i = 0; i < 3; ++i)
+        {
+            for (int j = 0; j < 3; ++j)
+                matrix->SetElement(i, j, R(i, j));
+            matrix->SetElement(i, 3, t(i));
+        }
+    }
+};
@@ -20,15 +20,79 @@ VTK_MODULE_INIT(vtkInteractionStyle);
 #include <vtkRenderWindow.h>
 #include <vtkRenderWindowInteractor.h>
 #include <vtkOrientationMarkerWidget.h> //坐标系交互
-int main()
+#include <vtkPolyDataWriter.h>
+#include <vtkMatrix4x4.h>
+#include <vtkSMPTools.h>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gicp.h"
+#include "pipeline.h"
+
+/**
+ * @brief 流水线中传递的一组扫描数据：源点集、目标点集以及配准结果。
+ */
+struct ScanPair
+{
+    int index = 0;
+    std::string fileName;
+    vtkSmartPointer<vtkPolyData> raw;
+    vtkSmartPointer<vtkPolyData> source;
+    vtkSmartPointer<vtkPolyData> target;
+    vtkSmartPointer<vtkPolyData> aligned;
+    vtkSmartPointer<vtkMatrix4x4> matrix;
+};
+
+/**
+ * @brief 流水线各阶段的并发度和队列容量。
+ */
+struct PipelineOptions
+{
+    int loadThreads = 1;
+    int preprocessThreads = 1;
+    int registerThreads = 0; // 0 表示自动：ICP 为 CPU 核数，GICP 为 1（GICP 内部已用 vtkSMPTools 并行）
+    int writeThreads = 1;
+    std::size_t queueCapacity = 4;
+    bool gicp = false;      // 使用 GICP 代替 vtkIterativeClosestPointTransform
+    int gicpNeighbors = 20; // GICP 估计协方差时的近邻点数
+};
+
+/**
+ * @brief 读取阶段：从文件加载点云。
+ *
+ * @param pair 待处理的扫描数据，需已设置 fileName。
+ * @return 读取成功返回填充了 raw 的扫描数据，失败返回 std::nullopt。
+ */
+std::optional<ScanPair> LoadScan(ScanPair &pair)
 {
     vtkSmartPointer<vtkPolyDataReader> reader =
         vtkSmartPointer<vtkPolyDataReader>::New();
-    reader->SetFileName("E:\\Code\\forTest\\fran_cut.vtk");
+    reader->SetFileName(pair.fileName.c_str());
     reader->Update();
 
+    if (!reader->GetOutput() || reader->GetOutput()->GetNumberOfPoints() == 0)
+    {
+        std::cerr << "Failed to read " << pair.fileName << std::endl;
+        return std::nullopt;
+    }
+    pair.raw = reader->GetOutput();
+    return std::move(pair);
+}
+
+/**
+ * @brief 预处理阶段：构造浮动数据点集，并为源、目标点集生成顶点单元。
+ *
+ * @param pair 已完成读取的扫描数据。
+ * @return 填充了 source 和 target 的扫描数据。
+ */
+std::optional<ScanPair> PreprocessScan(ScanPair &pair)
+{
     // 构造浮动数据点集
-    vtkSmartPointer<vtkPolyData> orig = reader->GetOutput();
     vtkSmartPointer<vtkTransform> trans =
         vtkSmartPointer<vtkTransform>::New();
     trans->Translate(0.2, 0.1, 0.1);
@@ -36,14 +100,14 @@ int main()
 
     vtkSmartPointer<vtkTransformPolyDataFilter> transformFilter1 =
         vtkSmartPointer<vtkTransformPolyDataFilter>::New();
-    transformFilter1->SetInputData(reader->GetOutput());
+    transformFilter1->SetInputData(pair.raw);
     transformFilter1->SetTransform(trans);
     transformFilter1->Update();
     /*********************************************************/
     // 源数据 与 目标数据
     vtkSmartPointer<vtkPolyData> source =
         vtkSmartPointer<vtkPolyData>::New();
-    source->SetPoints(orig->GetPoints());
+    source->SetPoints(pair.raw->GetPoints());
 
     vtkSmartPointer<vtkPolyData> target =
         vtkSmartPointer<vtkPolyData>::New();
@@ -59,37 +123,203 @@ int main()
     targetGlyph->SetInputData(target);
     targetGlyph->Update();
 
-    // 进行ICP配准求变换矩阵
-    vtkSmartPointer<vtkIterativeClosestPointTransform> icptrans =
-        vtkSmartPointer<vtkIterativeClosestPointTransform>::New();
-    icptrans->SetSource(sourceGlyph->GetOutput());
-    icptrans->SetTarget(targetGlyph->GetOutput());
-    icptrans->GetLandmarkTransform()->SetModeToRigidBody();
-    icptrans->SetMaximumNumberOfIterations(50);
-    icptrans->StartByMatchingCentroidsOn(); // 去偏移（中心归一/重心归一）
-    icptrans->Modified();
-    icptrans->Update();
-
-    vtkMatrix4x4 *M = icptrans->GetMatrix();
-    cout << "The resulting matrix is: " << *M << endl;
+    pair.source = sourceGlyph->GetOutput();
+    pair.target = targetGlyph->GetOutput();
+    pair.raw = nullptr; // 原始数据不再需要，尽早释放
+    return std::move(pair);
+}
+
+/**
+ * @brief 配准阶段：进行ICP配准求变换矩阵，并用配准矩阵调整源数据。
+ *
+ * 指定 --gicp 时改用 GICP：先并行估计源、目标点集每个点的协方差，
+ * 再以加权的 Gauss-Newton 迭代求解刚体变换。
+ *
+ * @param pair 已完成预处理的扫描数据。
+ * @param options 流水线参数。
+ * @return 填充了 matrix 和 aligned 的扫描数据。
+ */
+std::optional<ScanPair> RegisterScan(ScanPair &pair, const PipelineOptions &options)
+{
+    pair.matrix = vtkSmartPointer<vtkMatrix4x4>::New();
+    vtkSmartPointer<vtkTransform> transform =
+        vtkSmartPointer<vtkTransform>::New();
+
+    if (options.gicp)
+    {
+        GICPCloud source;
+        GICPCloud target;
+        source.Prepare(pair.source, options.gicpNeighbors);
+        target.Prepare(pair.target, options.gicpNeighbors);
+
+        GICPRegistration gicp;
+        gicp.SetMaximumNumberOfIterations(50);
+        gicp.SetStartByMatchingCentroids(true); // 去偏移（中心归一/重心归一）
+        gicp.SetMaximumCorrespondenceDistance(pair.target->GetLength() * 0.1);
+        gicp.Register(source, target, pair.matrix);
+    }
+    else
+    {
+        // 进行ICP配准求变换矩阵
+        vtkSmartPointer<vtkIterativeClosestPointTransform> icptrans =
+            vtkSmartPointer<vtkIterativeClosestPointTransform>::New();
+        icptrans->SetSource(pair.source);
+        icptrans->SetTarget(pair.target);
+        icptrans->GetLandmarkTransform()->SetModeToRigidBody();
+        icptrans->SetMaximumNumberOfIterations(50);
+        icptrans->StartByMatchingCentroidsOn(); // 去偏移（中心归一/重心归一）
+        icptrans->Modified();
+        icptrans->Update();
+        pair.matrix->DeepCopy(icptrans->GetMatrix());
+    }
+    transform->SetMatrix(pair.matrix);
+
+    // 配准矩阵调整源数据
+    vtkSmartPointer<vtkTransformPolyDataFilter> solution =
+        vtkSmartPointer<vtkTransformPolyDataFilter>::New();
+    solution->SetInputData(pair.source);
+    solution->SetTransform(transform);
+    solution->Update();
+    pair.aligned = solution->GetOutput();
+    return std::move(pair);
+}
+
+/**
+ * @brief 写出阶段：打印变换矩阵，并将配准后的点集写到 <fileName>.aligned.vtk。
+ *
+ * @param pair 已完成配准的扫描数据。
+ * @return 原样返回扫描数据，供主线程显示。
+ */
+std::optional<ScanPair> WriteScan(ScanPair &pair)
+{
+    vtkSmartPointer<vtkPolyDataWriter> writer =
+        vtkSmartPointer<vtkPolyDataWriter>::New();
+    writer->SetFileName((pair.fileName + ".aligned.vtk").c_str());
+    writer->SetInputData(pair.aligned);
+    writer->Write();
+
+    // 多个写出线程同时打印时避免输出交错
+    static std::mutex coutMutex;
+    std::lock_guard<std::mutex> lock(coutMutex);
+    cout << "[" << pair.index << "] " << pair.fileName
+         << "\nThe resulting matrix is: " << *pair.matrix << endl;
     for (int i = 0; i <= 3; i++)
     {
         printf("\n");
         for (int j = 0; j <= 3; j++)
         {
-            printf("%e\t", M->Element[i][j]);
+            printf("%e\t", pair.matrix->Element[i][j]);
         }
     }
-    // 配准矩阵调整源数据
-    vtkSmartPointer<vtkTransformPolyDataFilter> solution =
-        vtkSmartPointer<vtkTransformPolyDataFilter>::New();
-    solution->SetInputData(sourceGlyph->GetOutput());
-    solution->SetTransform(icptrans);
-    solution->Update();
+    printf("\n");
+    return std::move(pair);
+}
+
+/**
+ * @brief 解析命令行参数。
+ *
+ * 用法：main [--load N] [--preprocess N] [--register N] [--write N] [--queue N]
+ *           [--gicp] [--gicp-neighbors K] file1.vtk file2.vtk ...
+ * 未指定文件时使用默认的 fran_cut.vtk。
+ *
+ * @param argc 参数个数。
+ * @param argv 参数列表。
+ * @param options 解析得到的流水线参数。
+ * @param files 解析得到的输入文件列表。
+ */
+void ParseArguments(int argc, char *argv[], PipelineOptions &options, std::vector<std::string> &files)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        bool hasValue = i + 1 < argc;
+        if (hasValue && std::strcmp(argv[i], "--load") == 0)
+            options.loadThreads = std::atoi(argv[++i]);
+        else if (hasValue && std::strcmp(argv[i], "--preprocess") == 0)
+            options.preprocessThreads = std::atoi(argv[++i]);
+        else if (hasValue && std::strcmp(argv[i], "--register") == 0)
+            options.registerThreads = std::max(1, std::atoi(argv[++i]));
+        else if (hasValue && std::strcmp(argv[i], "--write") == 0)
+            options.writeThreads = std::atoi(argv[++i]);
+        else if (hasValue && std::strcmp(argv[i], "--queue") == 0)
+            options.queueCapacity = static_cast<std::size_t>(std::max(1, std::atoi(argv[++i])));
+        else if (hasValue && std::strcmp(argv[i], "--gicp-neighbors") == 0)
+            options.gicpNeighbors = std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--gicp") == 0)
+            options.gicp = true;
+        else
+            files.push_back(argv[i]);
+    }
+    if (files.empty())
+        files.push_back("E:\\Code\\forTest\\fran_cut.vtk");
+
+    int cores = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    if (options.registerThreads <= 0)
+        options.registerThreads = options.gicp ? 1 : cores;
+    if (options.gicp)
+    {
+        // 每个配准线程内部的 vtkSMPTools 并行再占满所有核会得到约 核数^2 个线程，
+        // 因此按配准线程数平分 SMP 线程
+        vtkSMPTools::Initialize(std::max(1, cores / options.registerThreads));
+    }
+}
+
+/**
+ * @brief 以流水线方式批量配准多组扫描数据，并显示第一组的配准结果。
+ *
+ * 读取 → 预处理 → 配准 → 写出 四个阶段之间以有界队列相连，
+ * 第 N 组配准时第 N+1 组的读取和第 N-1 组的写出可以同时进行。
+ * 队列满时上游阶段阻塞，避免读取过快导致内存无限增长。
+ * 第一组读取失败时显示输入顺序中下一组配准成功的数据。
+ *
+ * @return 0 表示成功，1 表示没有任何一组数据配准成功。
+ */
+int main(int argc, char *argv[])
+{
+    PipelineOptions options;
+    std::vector<std::string> files;
+    ParseArguments(argc, argv, options, files);
+
+    BoundedQueue<ScanPair> loadQueue(options.queueCapacity);
+    BoundedQueue<ScanPair> preprocessQueue(options.queueCapacity);
+    BoundedQueue<ScanPair> registerQueue(options.queueCapacity);
+    BoundedQueue<ScanPair> writeQueue(options.queueCapacity);
+    BoundedQueue<ScanPair> doneQueue(options.queueCapacity);
+
+    PipelineStage<ScanPair, ScanPair> loadStage(loadQueue, preprocessQueue, options.loadThreads, LoadScan);
+    PipelineStage<ScanPair, ScanPair> preprocessStage(preprocessQueue, registerQueue, options.preprocessThreads, PreprocessScan);
+    PipelineStage<ScanPair, ScanPair> registerStage(registerQueue, writeQueue, options.registerThreads,
+                                                    [&options](ScanPair &pair)
+                                                    { return RegisterScan(pair, options); });
+    PipelineStage<ScanPair, ScanPair> writeStage(writeQueue, doneQueue, options.writeThreads, WriteScan);
+
+    // 投递任务的线程与主线程分开，否则 loadQueue 满时主线程无法消费 doneQueue
+    std::thread feeder([&]
+                       {
+        for (std::size_t i = 0; i < files.size(); ++i)
+        {
+            ScanPair pair;
+            pair.index = static_cast<int>(i);
+            pair.fileName = files[i];
+            loadQueue.push(std::move(pair));
+        }
+        loadQueue.close(); });
+
+    // 只保留输入顺序中最靠前的一组用于显示（与完成顺序无关），其余结果已写入文件
+    ScanPair shown;
+    ScanPair finished;
+    while (doneQueue.pop(finished))
+    {
+        if (!shown.aligned || finished.index < shown.index)
+            shown = std::move(finished);
+    }
+    feeder.join();
+
+    if (!shown.aligned)
+        return 1;
     //
     vtkSmartPointer<vtkPolyDataMapper> sourceMapper =
         vtkSmartPointer<vtkPolyDataMapper>::New();
-    sourceMapper->SetInputConnection(sourceGlyph->GetOutputPort());
+    sourceMapper->SetInputData(shown.source);
     vtkSmartPointer<vtkActor> sourceActor =
         vtkSmartPointer<vtkActor>::New();
     sourceActor->SetMapper(sourceMapper);
@@ -98,7 +328,7 @@ int main()
 
     vtkSmartPointer<vtkPolyDataMapper> targetMapper =
         vtkSmartPointer<vtkPolyDataMapper>::New();
-    targetMapper->SetInputConnection(targetGlyph->GetOutputPort());
+    targetMapper->SetInputData(shown.target);
     vtkSmartPointer<vtkActor> targetActor =
         vtkSmartPointer<vtkActor>::New();
     targetActor->SetMapper(targetMapper);
@@ -107,7 +337,7 @@ int main()
 
     vtkSmartPointer<vtkPolyDataMapper> soluMapper =
         vtkSmartPointer<vtkPolyDataMapper>::New();
-    soluMapper->SetInputConnection(solution->GetOutputPort());
+    soluMapper->SetInputData(shown.aligned);
     vtkSmartPointer<vtkActor> soluActor =
         vtkSmartPointer<vtkActor>::New();
     soluActor->SetMapper(soluMapper);
@@ -20,13 +20,17 @@
 #include <vtkSmartPointer.h>
 #include <vtkProperty.h>
 #include <vtkTransform.h>
+#include <vtkDataArray.h>
 #include <iostream>
 
+#include "synthetic_cloud.h"
+
 vtkPolyData *CreatePolyData();
 vtkPolyData *PerturbPolyData(vtkPolyData *polydata);
 vtkPolyData *TransformPolyData(vtkPolyData *sourcePolydata, vtkMatrix4x4 *matrix);
-vtkPolyData *ApplyRandomOffset(vtkPolyData *polydata); // 新增函数，给点集添加随机偏移
+vtkPolyData *ApplyRandomOffset(vtkPolyData *polydata, std::uint64_t seed); // 新增函数，给点集添加随机偏移
 void DisplayPolyData(vtkPolyData *targetPolydata, vtkPolyData *sourcePolydata, vtkPolyData *alignedPolydata);
+void ReportPolyDataMemory(const char *name, vtkPolyData *polydata);
 
 /**
  * @brief 使用 ICP 算法配准源点集和目标点集，
@@ -62,10 +66,15 @@ int main()
     // 将配准矩阵应用于源点集，生成配准后的点集
     vtkPolyData *AlignedPolydata = TransformPolyData(SourcePolydata, matrix);
 
+    // 输出各点集的内存占用
+    ReportPolyDataMemory("Target", TargetPolydata);
+    ReportPolyDataMemory("Source", SourcePolydata);
+    ReportPolyDataMemory("Aligned", AlignedPolydata);
+
     // 给源点集、目标点集和配准后的点集添加随机偏移，避免重叠
-    TargetPolydata = ApplyRandomOffset(TargetPolydata);
-    SourcePolydata = ApplyRandomOffset(SourcePolydata);
-    AlignedPolydata = ApplyRandomOffset(AlignedPolydata);
+    TargetPolydata = ApplyRandomOffset(TargetPolydata, 1);
+    SourcePolydata = ApplyRandomOffset(SourcePolydata, 2);
+    AlignedPolydata = ApplyRandomOffset(AlignedPolydata, 3);
 
     // 在窗口中显示目标点集、源点集和配准后的点集
     DisplayPolyData(TargetPolydata, SourcePolydata, AlignedPolydata);
@@ -122,14 +131,18 @@ vtkPolyData *CreatePolyData()
 /**
  * @brief 对输入的点集进行随机扰动，避免点集重叠
  *
+ * 只复制会被修改的点坐标，顶点单元等其余数据与输入点集共享。
+ *
  * @param[in] OldPolydata 输入的点集
  * @return 扰动后的点集
  */
 vtkPolyData *PerturbPolyData(vtkPolyData *OldPolydata)
 {
     vtkPolyData *polydata = vtkPolyData::New();
-    polydata->DeepCopy(OldPolydata);
-    vtkPoints *Points = polydata->GetPoints();
+    polydata->ShallowCopy(OldPolydata);
+    vtkSmartPointer<vtkPoints> Points = vtkSmartPointer<vtkPoints>::New();
+    Points->DeepCopy(OldPolydata->GetPoints());
+    polydata->SetPoints(Points);
 
     double p[3];
     Points->GetPoint(1, p);
@@ -154,22 +167,25 @@ vtkPolyData *PerturbPolyData(vtkPolyData *OldPolydata)
  * @brief 将点集中的每个点都进行小的随机偏移，避免重叠
  *
  * 该函数遍历输入点集中每个点，并在x和y方向上添加小的随机偏移，避免点重叠。
- * 偏移量的绝对值小于0.05。
+ * 偏移量的绝对值小于0.05。偏移量只由种子和点的下标决定，每次运行结果相同。
  *
  * @param[in] polydata 输入点集
+ * @param[in] seed 随机种子
  * @return 带有随机偏移的点集
  */
-vtkPolyData *ApplyRandomOffset(vtkPolyData *polydata)
+vtkPolyData *ApplyRandomOffset(vtkPolyData *polydata, std::uint64_t seed)
 {
     // 给点集应用小的随机偏移，避免重叠
+    CounterRng rng(seed);
     vtkPoints *points = polydata->GetPoints();
     for (vtkIdType i = 0; i < points->GetNumberOfPoints(); i++)
     {
         double p[3];
         points->GetPoint(i, p);
         // 在x和y方向上添加小的随机偏移
-        p[0] += (rand() % 1000) / 1000.0 * 0.05; // 偏移量为0.05
-        p[1] += (rand() % 1000) / 1000.0 * 0.05; // 偏移量为0.05
+        std::array<double, 4> u = rng.uniform(static_cast<std::uint64_t>(i));
+        p[0] += u[0] * 0.05; // 偏移量为0.05
+        p[1] += u[1] * 0.05; // 偏移量为0.05
         points->SetPoint(i, p);
     }
     return polydata;
@@ -179,6 +195,7 @@ vtkPolyData *ApplyRandomOffset(vtkPolyData *polydata)
  * @brief 对源点云应用仿射变换矩阵。
  *
  * 该函数将源vtkPolyData作为输入，并将给定的仿射变换矩阵应用于生成一个新的变换后的vtkPolyData。
+ * 过滤器的输出本身就是新分配的数据，这里只做浅拷贝，不再复制一遍点和单元。
  *
  * @param[in] sourcePolydata 输入点云以进行仿射变换。
  * @param[in] matrix 仿射变换矩阵。
@@ -195,7 +212,7 @@ vtkPolyData *TransformPolyData(vtkPolyData *sourcePolydata, vtkMatrix4x4 *matrix
     filter->Update();
 
     vtkPolyData *transformedPolydata = vtkPolyData::New();
-    transformedPolydata->DeepCopy(filter->GetOutput());
+    transformedPolydata->ShallowCopy(filter->GetOutput());
     return transformedPolydata;
 }
 
@@ -253,3 +270,25 @@ void DisplayPolyData(vtkPolyData *targetPolydata, vtkPolyData *sourcePolydata, v
     renderWindow->Render();
     renderWindowInteractor->Start();
 }
+
+/**
+ * @brief 输出点集及其点坐标数组、顶点单元的内存占用。
+ *
+ * 浅拷贝共享的数组会在每个引用它的点集中重复计入，因此各点集之和可能大于实际占用。
+ *
+ * @param[in] name 点集名称。
+ * @param[in] polydata 需要统计的点集。
+ */
+void ReportPolyDataMemory(const char *name, vtkPolyData *polydata)
+{
+    // GetActualMemorySize 的单位为 KiB
+    unsigned long pointsKiB = 0;
+    if (polydata->GetPoints())
+        pointsKiB = polydata->GetPoints()->GetData()->GetActualMemorySize();
+    unsigned long vertsKiB = polydata->GetVerts() ? polydata->GetVerts()->GetActualMemorySize() : 0;
+
+    std::cout << name << " polydata: " << polydata->GetActualMemorySize() << " KiB"
+              << " (points " << polydata->GetNumberOfPoints() << ", " << pointsKiB << " KiB"
+              << "; verts " << polydata->GetNumberOfVerts() << ", " << vertsKiB << " KiB)"
+              << std::endl;
+}
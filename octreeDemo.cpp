@@ -10,8 +10,19 @@
 #include <vtkProperty.h>
 #include <vtkVertexGlyphFilter.h>
 #include <vtkCamera.h>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
 #include <vector>
-#include <random>
+
+#include "synthetic_cloud.h"
 
 // 点云结构
 struct Point3D
@@ -32,13 +43,47 @@ struct Point3D
         : x(_x), y(_y), z(_z) {}
 };
 
+/**
+ * @brief 空间中的一个平面，满足 normal·p + d >= 0 的点位于平面内侧。
+ */
+struct Plane
+{
+    Point3D normal;
+    double d;
+
+    /**
+     * @brief 计算点到平面的有符号距离（法向量为单位向量时）。
+     *
+     * @param p 需要计算的点。
+     * @return 正值表示位于内侧，负值表示位于外侧。
+     */
+    double signedDistance(const Point3D &p) const
+    {
+        return normal.x * p.x + normal.y * p.y + normal.z * p.z + d;
+    }
+};
+
+/**
+ * @brief 八叉树点存储中的一段连续下标区间 [begin, end)。
+ */
+struct PointSpan
+{
+    std::size_t begin;
+    std::size_t end;
+
+    std::size_t size() const { return end - begin; }
+};
+
 class OctreeNode
 {
 public:
     Point3D center;
     double size;
     int depth;
-    std::vector<Point3D> points;
+    std::size_t begin = 0; // 节点内的点在八叉树点存储中的起始下标
+    std::size_t end = 0;   // 节点内的点在八叉树点存储中的结束下标（不含）
+    Point3D boundsMin;     // 节点内点的紧包围盒
+    Point3D boundsMax;
     std::vector<OctreeNode *> children;
 
     /**
@@ -53,6 +98,18 @@ public:
     OctreeNode(const Point3D &_center, double _size, int _depth = 0)
         : center(_center), size(_size), depth(_depth) {}
 
+    /**
+     * @brief 递归释放所有子节点。
+     */
+    ~OctreeNode()
+    {
+        for (auto child : children)
+            delete child;
+    }
+
+    OctreeNode(const OctreeNode &) = delete;
+    OctreeNode &operator=(const OctreeNode &) = delete;
+
     /**
      * @brief 判断该节点是否是叶子节点。
      *        叶子节点是没有子节点的节点。
@@ -62,6 +119,43 @@ public:
     {
         return children.empty();
     }
+
+    /**
+     * @brief 节点（含所有子节点）包含的点数。
+     */
+    std::size_t pointCount() const
+    {
+        return end - begin;
+    }
+};
+
+/**
+ * @brief 八叉树的内存占用统计。
+ */
+struct OctreeMemoryStats
+{
+    std::size_t nodeCount = 0;
+    std::size_t leafCount = 0;
+    std::size_t nodeBytes = 0;            // 所有节点及其子节点指针数组的字节数
+    std::size_t pointStorageBytes = 0;    // 八叉树点存储的字节数
+    std::size_t duplicatedPointBytes = 0; // 构建时从调用方复制的点的字节数，调用方仍持有一份相同的数据
+    std::size_t peakBuildBytes = 0;       // 构建过程中八叉树占用内存的峰值
+    std::vector<std::size_t> nodesPerLevel;
+    std::vector<std::size_t> bytesPerLevel;
+    int configuredMaxDepth = 0; // 构造时指定的最大深度
+    int appliedMaxDepth = 0;    // 实际构建使用的最大深度，Degrade 策略下可能小于 configuredMaxDepth
+    bool degraded = false;      // 是否因超出内存预算而降低了最大深度
+
+    std::size_t totalBytes() const { return nodeBytes + pointStorageBytes; }
+};
+
+/**
+ * @brief 构建八叉树时超出内存预算的处理方式。
+ */
+enum class MemoryBudgetPolicy
+{
+    FailFast, // 抛出 std::length_error
+    Degrade   // 整棵树统一降低最大深度，以较浅的树完成构建
 };
 
 class Octree
@@ -70,31 +164,26 @@ private:
     const int MAX_DEPTH;
     const int MIN_POINTS;
     OctreeNode *root;
+    // 按八叉树节点顺序重排后的点，每个节点的点在其中占据一段连续区间
+    std::vector<Point3D> storage;
+
+    // 内存预算（0 表示不限制）及构建过程中的内存统计
+    std::size_t memoryBudget = 0;
+    MemoryBudgetPolicy budgetPolicy = MemoryBudgetPolicy::FailFast;
+    std::size_t buildBytes = 0;
+    std::size_t peakBuildBytes = 0;
+    std::size_t duplicatedPointBytes = 0;
+    int appliedMaxDepth; // 本次构建实际使用的最大深度
 
     /**
-     * @brief 根据点的坐标和八叉树中心点，
-     *        计算该点在八叉树中的八面体索引（octant）。
-     *
-     * 该函数将点的坐标与八叉树中心点的坐标进行
-     * 比较，计算出该点在八叉树中的八面体索引（
-     * octant）。八面体索引使用三个位来表示x、y、z
-     * 三个轴上的位置（0表示负方向，1表示正方向）。
-     *
-     * @param point 需要计算的点的坐标。
-     * @param center 八叉树中心点的坐标。
-     * @return 该点在八叉树中的八面体索引（octant）。
+     * @brief 节点与查询区域的位置关系。
      */
-    int getOctant(const Point3D &point, const Point3D &center)
+    enum class Containment
     {
-        int octant = 0;
-        if (point.x >= center.x)
-            octant |= 4;
-        if (point.y >= center.y)
-            octant |= 2;
-        if (point.z >= center.z)
-            octant |= 1;
-        return octant;
-    }
+        Outside,
+        Intersecting,
+        Inside
+    };
 
     /**
      * @brief 计算给定八叉体子节点的中心点。
@@ -117,6 +206,389 @@ private:
             parent_center.z + ((octant & 1) ? offset : -offset));
     }
 
+    /**
+     * @brief 沿 x、y、z 依次原地划分 [begin, end) 区间。
+     *
+     * 划分后 bounds[i] 到 bounds[i + 1] 为第 i 个八面体的点，八面体索引
+     * 使用三个位表示x、y、z三个轴上的位置（0表示负方向，1表示正方向）。
+     *
+     * @param begin 区间起始下标。
+     * @param end 区间结束下标（不含）。
+     * @param center 划分所用的中心点。
+     * @param bounds 输出的9个边界下标。
+     * @return 非空八面体的个数。
+     */
+    std::size_t partitionOctants(std::size_t begin, std::size_t end, const Point3D &center, std::size_t bounds[9])
+    {
+        bounds[0] = begin;
+        bounds[8] = end;
+        auto first = storage.begin();
+        auto splitX = [&center](const Point3D &p)
+        { return p.x < center.x; };
+        auto splitY = [&center](const Point3D &p)
+        { return p.y < center.y; };
+        auto splitZ = [&center](const Point3D &p)
+        { return p.z < center.z; };
+
+        bounds[4] = std::partition(first + begin, first + end, splitX) - first;
+        for (int x = 0; x < 8; x += 4)
+        {
+            bounds[x + 2] = std::partition(first + bounds[x], first + bounds[x + 4], splitY) - first;
+            for (int y = x; y < x + 4; y += 2)
+            {
+                bounds[y + 1] = std::partition(first + bounds[y], first + bounds[y + 2], splitZ) - first;
+            }
+        }
+
+        std::size_t non_empty = 0;
+        for (int i = 0; i < 8; ++i)
+        {
+            if (bounds[i + 1] > bounds[i])
+                ++non_empty;
+        }
+        return non_empty;
+    }
+
+    /**
+     * @brief 不分配节点，统计按 MAX_DEPTH 完整构建时每一层的节点字节数。
+     *
+     * level_bytes[d] 为第 d 层所有节点加上第 d - 1 层被细分节点的子节点指针数组的字节数，
+     * 因此最大深度为 d 的树占用 level_bytes[0..d] 之和。
+     */
+    void countLevelBytes(std::size_t begin,
+                         std::size_t end,
+                         const Point3D &center,
+                         double size,
+                         int depth,
+                         std::vector<std::size_t> &level_bytes)
+    {
+        if (level_bytes.size() <= static_cast<std::size_t>(depth))
+            level_bytes.resize(depth + 1, 0);
+        level_bytes[depth] += sizeof(OctreeNode);
+
+        if (depth >= MAX_DEPTH || end - begin <= static_cast<std::size_t>(MIN_POINTS))
+            return;
+
+        std::size_t bounds[9];
+        if (partitionOctants(begin, end, center, bounds) <= 1)
+            return;
+
+        if (level_bytes.size() <= static_cast<std::size_t>(depth + 1))
+            level_bytes.resize(depth + 2, 0);
+        level_bytes[depth + 1] += 8 * sizeof(OctreeNode *);
+
+        double child_size = size * 0.5;
+        for (int i = 0; i < 8; ++i)
+        {
+            if (bounds[i + 1] > bounds[i])
+            {
+                countLevelBytes(bounds[i], bounds[i + 1], calculateChildCenter(center, i, child_size),
+                                child_size, depth + 1, level_bytes);
+            }
+        }
+    }
+
+    /**
+     * @brief 在点存储的 [begin, end) 区间上递归构建八叉树节点。
+     *
+     * 与按八面体复制子点集不同，这里用 partitionOctants 原地划分区间，
+     * 划分后八个子节点的点按八面体索引顺序连续排列，不产生额外的点拷贝。
+     *
+     * @param begin 节点的点在存储中的起始下标。
+     * @param end 节点的点在存储中的结束下标（不含）。
+     * @param center 当前八叉树节点的中心点。
+     * @param size 当前八叉树节点的立方体空间的大小。
+     * @param depth 当前八叉树节点的深度级别。
+     * @return 构建的节点指针。
+     */
+    OctreeNode *buildNode(std::size_t begin,
+                          std::size_t end,
+                          const Point3D &center,
+                          double size,
+                          int depth)
+    {
+        // 子节点构建失败（超出内存预算）时由 unique_ptr 释放已构建的部分
+        std::unique_ptr<OctreeNode> node(new OctreeNode(center, size, depth));
+        node->begin = begin;
+        node->end = end;
+
+        if (depth >= appliedMaxDepth || end - begin <= static_cast<std::size_t>(MIN_POINTS))
+        {
+            computeLeafBounds(node.get());
+            return node.release();
+        }
+
+        std::size_t bounds[9];
+        std::size_t non_empty = partitionOctants(begin, end, center, bounds);
+        if (non_empty <= 1)
+        {
+            computeLeafBounds(node.get());
+            return node.release();
+        }
+        reserveBuildBytes(8 * sizeof(OctreeNode *) + non_empty * sizeof(OctreeNode));
+
+        double child_size = size * 0.5;
+        node->children.resize(8);
+        bool first_child = true;
+        for (int i = 0; i < 8; ++i)
+        {
+            if (bounds[i + 1] > bounds[i])
+            {
+                Point3D child_center = calculateChildCenter(center, i, child_size);
+                OctreeNode *child = buildNode(bounds[i], bounds[i + 1], child_center, child_size, depth + 1);
+                node->children[i] = child;
+                mergeBounds(node.get(), child, first_child);
+                first_child = false;
+            }
+        }
+
+        return node.release();
+    }
+
+    /**
+     * @brief 在内存预算中登记即将分配的字节数，并更新峰值。
+     *
+     * @param bytes 即将分配的字节数。
+     * @throw std::length_error 超出预算时抛出。
+     */
+    void reserveBuildBytes(std::size_t bytes)
+    {
+        if (memoryBudget > 0 && buildBytes + bytes > memoryBudget)
+        {
+            throw std::length_error("Octree build exceeds memory budget of " +
+                                    std::to_string(memoryBudget) + " bytes");
+        }
+        buildBytes += bytes;
+        peakBuildBytes = std::max(peakBuildBytes, buildBytes);
+    }
+
+    /**
+     * @brief 释放之前构建的八叉树并清零内存统计。
+     */
+    void resetBuild()
+    {
+        delete root;
+        root = nullptr;
+        storage.clear();
+        storage.shrink_to_fit();
+        buildBytes = 0;
+        peakBuildBytes = 0;
+        duplicatedPointBytes = 0;
+        appliedMaxDepth = MAX_DEPTH;
+    }
+
+    /**
+     * @brief 在已填充的点存储上构建根节点。
+     *
+     * Degrade 策略下先不分配节点地统计完整构建时每层的字节数，再选取预算内
+     * 能容纳的最大深度，整棵树统一按该深度构建，而不是先建满的子树占用预算、
+     * 后建的子树退化为大叶子。
+     */
+    OctreeNode *buildRoot(const Point3D &center, double size)
+    {
+        appliedMaxDepth = MAX_DEPTH;
+        if (memoryBudget > 0 && budgetPolicy == MemoryBudgetPolicy::Degrade)
+        {
+            std::vector<std::size_t> level_bytes;
+            countLevelBytes(0, storage.size(), center, size, 0, level_bytes);
+
+            std::size_t total = buildBytes;
+            int depth = -1;
+            while (depth + 1 < static_cast<int>(level_bytes.size()) &&
+                   total + level_bytes[depth + 1] <= memoryBudget)
+            {
+                total += level_bytes[++depth];
+            }
+            // 连根节点都放不下时仍按深度0构建，由 reserveBuildBytes 抛出异常
+            if (depth + 1 < static_cast<int>(level_bytes.size()))
+                appliedMaxDepth = std::max(depth, 0);
+        }
+
+        reserveBuildBytes(sizeof(OctreeNode));
+        root = buildNode(0, storage.size(), center, size, 0);
+        return root;
+    }
+
+    /**
+     * @brief 递归统计每一层的节点数和字节数。
+     */
+    void collectMemoryStats(const OctreeNode *node, OctreeMemoryStats &stats) const
+    {
+        std::size_t bytes = sizeof(OctreeNode) + node->children.capacity() * sizeof(OctreeNode *);
+        if (stats.nodesPerLevel.size() <= static_cast<std::size_t>(node->depth))
+        {
+            stats.nodesPerLevel.resize(node->depth + 1, 0);
+            stats.bytesPerLevel.resize(node->depth + 1, 0);
+        }
+        ++stats.nodesPerLevel[node->depth];
+        stats.bytesPerLevel[node->depth] += bytes;
+        ++stats.nodeCount;
+        stats.nodeBytes += bytes;
+        if (node->isLeaf())
+            ++stats.leafCount;
+
+        for (const auto child : node->children)
+        {
+            if (child)
+                collectMemoryStats(child, stats);
+        }
+    }
+
+    /**
+     * @brief 由节点区间内的点计算叶子节点的紧包围盒。
+     *
+     * @param node 叶子节点。
+     */
+    void computeLeafBounds(OctreeNode *node)
+    {
+        node->boundsMin = node->boundsMax = node->center;
+        if (node->begin == node->end)
+            return;
+
+        node->boundsMin = node->boundsMax = storage[node->begin];
+        for (std::size_t i = node->begin + 1; i < node->end; ++i)
+        {
+            const Point3D &p = storage[i];
+            node->boundsMin = Point3D(std::min(node->boundsMin.x, p.x),
+                                      std::min(node->boundsMin.y, p.y),
+                                      std::min(node->boundsMin.z, p.z));
+            node->boundsMax = Point3D(std::max(node->boundsMax.x, p.x),
+                                      std::max(node->boundsMax.y, p.y),
+                                      std::max(node->boundsMax.z, p.z));
+        }
+    }
+
+    /**
+     * @brief 将子节点的包围盒合并到父节点的包围盒中。
+     *
+     * @param node 父节点。
+     * @param child 子节点。
+     * @param first 是否为父节点的第一个子节点（此时直接复制子节点包围盒）。
+     */
+    void mergeBounds(OctreeNode *node, const OctreeNode *child, bool first)
+    {
+        if (first)
+        {
+            node->boundsMin = child->boundsMin;
+            node->boundsMax = child->boundsMax;
+            return;
+        }
+        node->boundsMin = Point3D(std::min(node->boundsMin.x, child->boundsMin.x),
+                                  std::min(node->boundsMin.y, child->boundsMin.y),
+                                  std::min(node->boundsMin.z, child->boundsMin.z));
+        node->boundsMax = Point3D(std::max(node->boundsMax.x, child->boundsMax.x),
+                                  std::max(node->boundsMax.y, child->boundsMax.y),
+                                  std::max(node->boundsMax.z, child->boundsMax.z));
+    }
+
+    /**
+     * @brief 判断节点包围盒与由若干平面围成的凸区域的位置关系。
+     *
+     * 对每个平面比较包围盒中心的有符号距离与包围盒在平面法向上的投影半径。
+     * 该判断是保守的：返回 Outside 时节点一定在区域外，返回 Intersecting
+     * 时节点可能实际位于区域外，此时由逐点测试得到正确结果。
+     *
+     * @param node 需要判断的节点。
+     * @param planes 凸区域的边界平面。
+     * @return 节点与区域的位置关系。
+     */
+    Containment classifyNode(const OctreeNode *node, const std::vector<Plane> &planes) const
+    {
+        Point3D c((node->boundsMin.x + node->boundsMax.x) * 0.5,
+                  (node->boundsMin.y + node->boundsMax.y) * 0.5,
+                  (node->boundsMin.z + node->boundsMax.z) * 0.5);
+        Point3D h((node->boundsMax.x - node->boundsMin.x) * 0.5,
+                  (node->boundsMax.y - node->boundsMin.y) * 0.5,
+                  (node->boundsMax.z - node->boundsMin.z) * 0.5);
+
+        Containment result = Containment::Inside;
+        for (const auto &plane : planes)
+        {
+            double s = plane.signedDistance(c);
+            double r = h.x * std::abs(plane.normal.x) +
+                       h.y * std::abs(plane.normal.y) +
+                       h.z * std::abs(plane.normal.z);
+            if (s + r < 0)
+                return Containment::Outside;
+            if (s - r < 0)
+                result = Containment::Intersecting;
+        }
+        return result;
+    }
+
+    /**
+     * @brief 将区间追加到查询结果中，与上一个区间相邻时直接合并。
+     *
+     * @param spans 查询结果。
+     * @param begin 区间起始下标。
+     * @param end 区间结束下标（不含）。
+     */
+    static void appendSpan(std::vector<PointSpan> &spans, std::size_t begin, std::size_t end)
+    {
+        if (begin == end)
+            return;
+        if (!spans.empty() && spans.back().end == begin)
+            spans.back().end = end;
+        else
+            spans.push_back({begin, end});
+    }
+
+    /**
+     * @brief 递归查询位于凸区域内的点。
+     *
+     * 完全位于区域内的子树整体作为一个区间返回，不再逐点测试；
+     * 只有与区域边界相交的叶子节点才逐点测试。
+     *
+     * @param node 当前节点。
+     * @param planes 凸区域的边界平面。
+     * @param spans 查询结果。
+     */
+    void queryNode(const OctreeNode *node, const std::vector<Plane> &planes, std::vector<PointSpan> &spans) const
+    {
+        Containment containment = classifyNode(node, planes);
+        if (containment == Containment::Outside)
+            return;
+        if (containment == Containment::Inside)
+        {
+            appendSpan(spans, node->begin, node->end);
+            return;
+        }
+
+        if (!node->isLeaf())
+        {
+            for (const auto child : node->children)
+            {
+                if (child)
+                    queryNode(child, planes, spans);
+            }
+            return;
+        }
+
+        std::size_t run_begin = node->begin;
+        for (std::size_t i = node->begin; i < node->end; ++i)
+        {
+            if (!containsPoint(planes, storage[i]))
+            {
+                appendSpan(spans, run_begin, i);
+                run_begin = i + 1;
+            }
+        }
+        appendSpan(spans, run_begin, node->end);
+    }
+
+    /**
+     * @brief 判断点是否位于所有平面的内侧。
+     */
+    static bool containsPoint(const std::vector<Plane> &planes, const Point3D &p)
+    {
+        for (const auto &plane : planes)
+        {
+            if (plane.signedDistance(p) < 0)
+                return false;
+        }
+        return true;
+    }
+
 public:
     /**
      * @brief 构建八叉树的对象，指定最大深度和最小点数阈值。
@@ -128,71 +600,202 @@ public:
      * @param min_points 一个节点中的最小点数阈值（缺省值为5）
      */
     Octree(int max_depth = 6, int min_points = 5)
-        : MAX_DEPTH(max_depth), MIN_POINTS(min_points), root(nullptr) {}
+        : MAX_DEPTH(max_depth), MIN_POINTS(min_points), root(nullptr), appliedMaxDepth(max_depth) {}
+
+    ~Octree() { delete root; }
+
+    Octree(const Octree &) = delete;
+    Octree &operator=(const Octree &) = delete;
+
+    /**
+     * @brief 设置构建八叉树时的内存预算。
+     *
+     * 预算包括点存储和所有节点占用的内存。点存储本身超出预算时总是抛出
+     * std::length_error；节点超出预算时按 policy 处理：FailFast 直接抛出，
+     * Degrade 降低整棵树的最大深度直到能放进预算。
+     *
+     * @param bytes 预算字节数，0 表示不限制。
+     * @param policy 超出预算时的处理方式。
+     */
+    void setMemoryBudget(std::size_t bytes, MemoryBudgetPolicy policy = MemoryBudgetPolicy::FailFast)
+    {
+        memoryBudget = bytes;
+        budgetPolicy = policy;
+    }
 
     /**
      * @brief 从一组3D点构建八叉树，指定中心点和大小。
      *
-     * 该函数递归地构建八叉树，通过将给定的空间分割成八个八面体
-     * 直到达到最大深度或某个节点中的点数小于阈值为止。
+     * 该函数将点复制到八叉树的点存储中，并递归地将给定的空间分割成八个八面体，
+     * 直到达到最大深度或某个节点中的点数小于阈值为止。构建过程中点存储被原地
+     * 重排，每个节点只记录其点在存储中的下标区间。构建结果同时设为根节点，
+     * 之前构建的树被释放。
      *
      * @param points 需要组织到八叉树中的3D点的向量。
-     * @param center 当前八叉树节点的中心点。
-     * @param size 当前八叉树节点的立方体空间的大小。
-     * @param depth 当前八叉树节点的深度级别（缺省值为0）。
+     * @param center 根节点的中心点。
+     * @param size 根节点的立方体空间的大小。
      * @return 构建的八叉树的根节点指针。
+     * @throw std::length_error 超出内存预算且策略为 FailFast 时抛出。
      */
     OctreeNode *buildOctree(const std::vector<Point3D> &points,
                             const Point3D &center,
-                            double size,
-                            int depth = 0)
+                            double size)
     {
-        OctreeNode *node = new OctreeNode(center, size, depth);
-        node->points = points;
+        resetBuild();
+        reserveBuildBytes(points.size() * sizeof(Point3D));
+        storage = points;
+        duplicatedPointBytes = points.size() * sizeof(Point3D);
+        return buildRoot(center, size);
+    }
 
-        if (depth >= MAX_DEPTH || points.size() <= MIN_POINTS)
-        {
-            return node;
-        }
+    /**
+     * @brief 从一组3D点构建八叉树，直接接管点的存储而不复制。
+     *
+     * 调用方不再需要原始点时使用此重载，可省去一份点云大小的内存。
+     *
+     * @param points 需要组织到八叉树中的3D点的向量，调用后为空。
+     * @param center 根节点的中心点。
+     * @param size 根节点的立方体空间的大小。
+     * @return 构建的八叉树的根节点指针。
+     * @throw std::length_error 超出内存预算且策略为 FailFast 时抛出。
+     */
+    OctreeNode *buildOctree(std::vector<Point3D> &&points,
+                            const Point3D &center,
+                            double size)
+    {
+        resetBuild();
+        reserveBuildBytes(points.capacity() * sizeof(Point3D));
+        storage = std::move(points);
+        return buildRoot(center, size);
+    }
 
-        std::vector<std::vector<Point3D>> child_points(8);
-        double child_size = size * 0.5;
+    /**
+     * @brief 统计八叉树当前的内存占用。
+     *
+     * @return 节点、点存储、逐层占用以及构建峰值等统计信息。
+     */
+    OctreeMemoryStats getMemoryStats() const
+    {
+        OctreeMemoryStats stats;
+        stats.pointStorageBytes = storage.capacity() * sizeof(Point3D);
+        stats.duplicatedPointBytes = duplicatedPointBytes;
+        stats.peakBuildBytes = peakBuildBytes;
+        stats.configuredMaxDepth = MAX_DEPTH;
+        stats.appliedMaxDepth = appliedMaxDepth;
+        stats.degraded = appliedMaxDepth < MAX_DEPTH;
+        if (root)
+            collectMemoryStats(root, stats);
+        return stats;
+    }
 
-        for (const auto &point : points)
+    /**
+     * @brief 输出八叉树的内存占用报告。
+     *
+     * @param os 输出流。
+     */
+    void printMemoryReport(std::ostream &os) const
+    {
+        OctreeMemoryStats stats = getMemoryStats();
+        os << "Octree memory report\n"
+           << "  nodes:            " << stats.nodeCount << " (" << stats.leafCount << " leaves), "
+           << stats.nodeBytes << " bytes\n"
+           << "  point storage:    " << stats.pointStorageBytes << " bytes\n"
+           << "  duplicated input: " << stats.duplicatedPointBytes << " bytes\n"
+           << "  total:            " << stats.totalBytes() << " bytes\n"
+           << "  peak build:       " << stats.peakBuildBytes << " bytes\n";
+        if (memoryBudget > 0)
+            os << "  budget:           " << memoryBudget << " bytes\n";
+        os << "  max depth:        " << stats.appliedMaxDepth << " (configured " << stats.configuredMaxDepth << ")"
+           << (stats.degraded ? ", reduced to fit memory budget" : "") << "\n";
+        for (std::size_t level = 0; level < stats.nodesPerLevel.size(); ++level)
         {
-            int octant = getOctant(point, node->center);
-            child_points[octant].push_back(point);
+            os << "  level " << level << ": " << stats.nodesPerLevel[level] << " nodes, "
+               << stats.bytesPerLevel[level] << " bytes\n";
         }
+        os.flush();
+    }
 
-        bool should_subdivide = false;
-        for (const auto &child_point_set : child_points)
+    /**
+     * @brief 查询位于轴对齐包围盒内的点。
+     *
+     * @param min 包围盒的最小角点。
+     * @param max 包围盒的最大角点。
+     * @return 点存储中的下标区间，通过 getPoints() 访问对应的点。
+     */
+    std::vector<PointSpan> queryBox(const Point3D &min, const Point3D &max) const
+    {
+        std::vector<Plane> planes = {
+            {Point3D(1, 0, 0), -min.x},
+            {Point3D(-1, 0, 0), max.x},
+            {Point3D(0, 1, 0), -min.y},
+            {Point3D(0, -1, 0), max.y},
+            {Point3D(0, 0, 1), -min.z},
+            {Point3D(0, 0, -1), max.z}};
+        return queryConvex(planes);
+    }
+
+    /**
+     * @brief 查询位于有向包围盒内的点。
+     *
+     * @param center 包围盒中心。
+     * @param axes 包围盒的三个轴方向，需为两两正交的单位向量。
+     * @param half_extents 包围盒沿三个轴方向的半边长。
+     * @return 点存储中的下标区间，通过 getPoints() 访问对应的点。
+     */
+    std::vector<PointSpan> queryOrientedBox(const Point3D &center,
+                                            const std::array<Point3D, 3> &axes,
+                                            const std::array<double, 3> &half_extents) const
+    {
+        std::vector<Plane> planes;
+        for (int i = 0; i < 3; ++i)
         {
-            if (!child_point_set.empty() && child_point_set.size() < points.size())
-            {
-                should_subdivide = true;
-                break;
-            }
+            const Point3D &a = axes[i];
+            double offset = a.x * center.x + a.y * center.y + a.z * center.z;
+            planes.push_back({a, half_extents[i] - offset});
+            planes.push_back({Point3D(-a.x, -a.y, -a.z), half_extents[i] + offset});
         }
+        return queryConvex(planes);
+    }
 
-        if (should_subdivide)
+    /**
+     * @brief 查询位于视锥体内的点。
+     *
+     * 平面格式与 vtkCamera::GetFrustumPlanes 的输出一致：每个平面依次为
+     * a、b、c、d 四个系数，法向量指向视锥体内部。
+     *
+     * @param planes 视锥体的6个平面，共24个系数。
+     * @return 点存储中的下标区间，通过 getPoints() 访问对应的点。
+     */
+    std::vector<PointSpan> queryFrustum(const double planes[24]) const
+    {
+        std::vector<Plane> frustum;
+        for (int i = 0; i < 6; ++i)
         {
-            node->children.resize(8);
-            for (int i = 0; i < 8; ++i)
-            {
-                if (!child_points[i].empty())
-                {
-                    Point3D child_center = calculateChildCenter(center, i, child_size);
-                    node->children[i] = buildOctree(child_points[i],
-                                                    child_center,
-                                                    child_size,
-                                                    depth + 1);
-                }
-            }
+            const double *p = planes + 4 * i;
+            frustum.push_back({Point3D(p[0], p[1], p[2]), p[3]});
         }
+        return queryConvex(frustum);
+    }
 
-        return node;
+    /**
+     * @brief 查询位于由若干平面围成的凸区域内的点。
+     *
+     * @param planes 凸区域的边界平面，法向量指向区域内部。
+     * @return 点存储中按升序排列且互不相邻的下标区间。
+     */
+    std::vector<PointSpan> queryConvex(const std::vector<Plane> &planes) const
+    {
+        std::vector<PointSpan> spans;
+        if (root)
+            queryNode(root, planes, spans);
+        return spans;
     }
 
+    /**
+     * @brief 按八叉树节点顺序重排后的点存储，查询返回的区间均指向该存储。
+     */
+    const std::vector<Point3D> &getPoints() const { return storage; }
+
     /**
      * 递归将八叉树中的每个节点可视化为一个立方体
      * @param node 要可视化的八叉树节点
@@ -273,7 +876,14 @@ public:
         renderer->AddActor(actor);
     }
 
-    void setRoot(OctreeNode *node) { root = node; }
+    void setRoot(OctreeNode *node)
+    {
+        if (node != root)
+        {
+            delete root;
+            root = node;
+        }
+    }
     OctreeNode *getRoot() { return root; }
 };
 
@@ -291,45 +901,64 @@ public:
  * - 启用抗锯齿以提高渲染质量。
  * - 启动渲染窗口交互。
  *
- * @return 0 表示成功完成。
+ * 可选参数 --points N 和 --seed S 指定点数和随机种子（默认 1000 个点、种子 0）。
+ * 可选参数 --memory-budget <MiB> 限制八叉树构建的内存，默认超出时统一降低整棵树的最大深度；
+ * 同时指定 --fail-fast 时超出预算直接报错退出。
+ *
+ * @return 0 表示成功完成，1 表示超出内存预算。
  */
-int main()
+int main(int argc, char *argv[])
 {
-    // 生成更有结构的点云
-    std::random_device rd;
-    std::mt19937 gen(rd());
-
-    // 创建clustered分布的点云
-    std::vector<Point3D> points;
-
-    // 生成几个聚类
-    std::vector<Point3D> centers = {
-        Point3D(-3, -3, -3),
-        Point3D(3, 3, 3),
-        Point3D(-3, 3, -3),
-        Point3D(3, -3, 3)};
-
-    std::normal_distribution<> cluster_dis(0.0, 1.0);
-
-    // 为每个聚类生成点
-    for (const auto &center : centers)
-    {
-        for (int i = 0; i < 250; ++i)
-        { // 每个聚类250个点
-            Point3D point(
-                center.x + cluster_dis(gen),
-                center.y + cluster_dis(gen),
-                center.z + cluster_dis(gen));
-            points.push_back(point);
-        }
+    std::size_t point_count = 1000;
+    std::uint64_t seed = 0;
+    std::size_t budget_mib = 0;
+    MemoryBudgetPolicy policy = MemoryBudgetPolicy::Degrade;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--points") == 0 && i + 1 < argc)
+            point_count = std::strtoull(argv[++i], nullptr, 10);
+        else if (std::strcmp(argv[i], "--seed") == 0 && i + 1 < argc)
+            seed = std::strtoull(argv[++i], nullptr, 10);
+        else if (std::strcmp(argv[i], "--memory-budget") == 0 && i + 1 < argc)
+            budget_mib = std::strtoull(argv[++i], nullptr, 10);
+        else if (std::strcmp(argv[i], "--fail-fast") == 0)
+            policy = MemoryBudgetPolicy::FailFast;
     }
 
+    // 生成更有结构的点云：几个高斯聚类，相同种子总是得到相同的点云
+    GaussianClusters clusters;
+    clusters.centers = {{-3, -3, -3}, {3, 3, 3}, {-3, 3, -3}, {3, -3, 3}};
+    clusters.stddev = 1.0;
+    clusters.seed = seed;
+
+    // 每个点只由种子和下标决定，可以分块并行生成
+    std::vector<Point3D> points(point_count);
+    ParallelChunks(point_count, 1 << 16, 0, [&](std::uint64_t begin, std::uint64_t end)
+                   {
+        for (std::uint64_t i = begin; i < end; ++i)
+        {
+            double p[3];
+            clusters.point(i, p);
+            points[i] = Point3D(p[0], p[1], p[2]);
+        } });
+
     // 创建八叉树
     Octree octree(6, 10); // 调整最大深度和最小点数
+    octree.setMemoryBudget(budget_mib * 1024 * 1024, policy);
+
     Point3D center(0, 0, 0);
     double size = 12.0;
-    OctreeNode *root = octree.buildOctree(points, center, size);
-    octree.setRoot(root);
+    try
+    {
+        // 点云交给八叉树接管，之后通过 getPoints() 访问，避免保留两份点
+        octree.buildOctree(std::move(points), center, size);
+    }
+    catch (const std::length_error &e)
+    {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    octree.printMemoryReport(std::cout);
 
     // 创建渲染器和窗口
     auto renderer = vtkSmartPointer<vtkRenderer>::New();
@@ -343,7 +972,7 @@ int main()
 
     // 添加可视化元素
     octree.addVisualizationCubes(octree.getRoot(), renderer);
-    octree.visualizePoints(points, renderer);
+    octree.visualizePoints(octree.getPoints(), renderer);
 
     // 设置窗口属性
     renderWindow->SetSize(1200, 900); // 增大窗口尺寸
@@ -355,6 +984,27 @@ int main()
     renderer->GetActiveCamera()->SetViewUp(0, 0, 1);
     renderer->ResetCamera();
 
+    // 区域查询：统计包围盒、有向包围盒和当前视锥体内的点数
+    auto countPoints = [](const std::vector<PointSpan> &spans)
+    {
+        std::size_t count = 0;
+        for (const auto &span : spans)
+            count += span.size();
+        return count;
+    };
+    auto boxSpans = octree.queryBox(Point3D(-5, -5, -5), Point3D(-1, -1, -1));
+    double s = std::sqrt(0.5);
+    auto obbSpans = octree.queryOrientedBox(Point3D(0, 0, 0),
+                                            {Point3D(s, s, 0), Point3D(-s, s, 0), Point3D(0, 0, 1)},
+                                            {6.0, 1.0, 6.0});
+    double frustumPlanes[24];
+    renderer->GetActiveCamera()->GetFrustumPlanes(1200.0 / 900.0, frustumPlanes);
+    auto frustumSpans = octree.queryFrustum(frustumPlanes);
+    std::cout << "Points in box: " << countPoints(boxSpans) << " (" << boxSpans.size() << " spans)\n"
+              << "Points in oriented box: " << countPoints(obbSpans) << " (" << obbSpans.size() << " spans)\n"
+              << "Points in view frustum: " << countPoints(frustumSpans) << " (" << frustumSpans.size() << " spans)"
+              << std::endl;
+
     // 启用抗锯齿
     renderWindow->SetMultiSamples(8);
 
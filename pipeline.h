@@ -0,0 +1,154 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief 有界阻塞队列，用于连接流水线中相邻的两个阶段。
+ *
+ * 队列满时 push 阻塞（反压），队列空时 pop 阻塞。上游全部结束后调用
+ * close()，下游在取完剩余元素后 pop 返回 false，从而逐级结束整条流水线。
+ */
+template <typename T>
+class BoundedQueue
+{
+private:
+    std::deque<T> items;
+    const std::size_t capacity;
+    bool closed = false;
+    std::mutex mutex;
+    std::condition_variable notFull;
+    std::condition_variable notEmpty;
+
+public:
+    /**
+     * @brief 构造一个指定容量的队列。
+     *
+     * @param _capacity 队列中最多缓存的元素个数（至少为1）。
+     */
+    explicit BoundedQueue(std::size_t _capacity)
+        : capacity(_capacity > 0 ? _capacity : 1) {}
+
+    /**
+     * @brief 放入一个元素，队列满时阻塞等待。
+     *
+     * @param item 要放入的元素。
+     * @return 队列已关闭时返回 false，元素被丢弃。
+     */
+    bool push(T item)
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        notFull.wait(lock, [this]
+                     { return closed || items.size() < capacity; });
+        if (closed)
+            return false;
+        items.push_back(std::move(item));
+        notEmpty.notify_one();
+        return true;
+    }
+
+    /**
+     * @brief 取出一个元素，队列空时阻塞等待。
+     *
+     * @param item 取出的元素。
+     * @return 队列已关闭且为空时返回 false。
+     */
+    bool pop(T &item)
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        notEmpty.wait(lock, [this]
+                      { return closed || !items.empty(); });
+        if (items.empty())
+            return false;
+        item = std::move(items.front());
+        items.pop_front();
+        notFull.notify_one();
+        return true;
+    }
+
+    /**
+     * @brief 关闭队列，唤醒所有等待中的生产者和消费者。
+     */
+    void close()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        closed = true;
+        notFull.notify_all();
+        notEmpty.notify_all();
+    }
+};
+
+/**
+ * @brief 流水线中的一个阶段：若干工作线程从输入队列取元素，处理后放入输出队列。
+ *
+ * 处理函数返回 std::nullopt 表示该元素处理失败并被丢弃，不会阻塞后续元素。
+ * 本阶段所有工作线程结束后自动关闭输出队列，下游阶段随之结束。
+ */
+template <typename In, typename Out>
+class PipelineStage
+{
+private:
+    std::vector<std::thread> workers;
+
+public:
+    using Function = std::function<std::optional<Out>(In &)>;
+
+    /**
+     * @brief 启动阶段的工作线程。
+     *
+     * @param input 输入队列。
+     * @param output 输出队列。
+     * @param concurrency 工作线程数（至少为1）。
+     * @param func 每个元素的处理函数，需可被多个线程同时调用。
+     */
+    PipelineStage(BoundedQueue<In> &input, BoundedQueue<Out> &output, int concurrency, Function func)
+    {
+        if (concurrency < 1)
+            concurrency = 1;
+
+        auto remaining = std::make_shared<std::size_t>(concurrency);
+        auto remainingMutex = std::make_shared<std::mutex>();
+        for (int i = 0; i < concurrency; ++i)
+        {
+            workers.emplace_back([&input, &output, func, remaining, remainingMutex]
+                                 {
+                In item;
+                while (input.pop(item))
+                {
+                    std::optional<Out> result = func(item);
+                    if (result && !output.push(std::move(*result)))
+                        break;
+                }
+
+                // 最后一个退出的线程负责关闭输出队列
+                std::lock_guard<std::mutex> lock(*remainingMutex);
+                if (--(*remaining) == 0)
+                    output.close(); });
+        }
+    }
+
+    PipelineStage(const PipelineStage &) = delete;
+    PipelineStage &operator=(const PipelineStage &) = delete;
+
+    /**
+     * @brief 等待本阶段所有工作线程结束。
+     */
+    void join()
+    {
+        for (auto &worker : workers)
+        {
+            if (worker.joinable())
+                worker.join();
+        }
+    }
+
+    ~PipelineStage() { join(); }
+};
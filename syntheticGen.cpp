@@ -0,0 +1,150 @@
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+#include "synthetic_cloud.h"
+
+/**
+ * @brief 输出命令行用法。
+ */
+void PrintUsage()
+{
+    std::cerr << "Usage: syntheticGen <clusters|plane|surface|pair> <count> <output.ply>\n"
+              << "                    [--seed S] [--threads N] [--chunk N]\n"
+              << "  pair writes <output>.source.ply, <output>.target.ply and the\n"
+              << "  ground-truth matrix to <output>.gt.txt" << std::endl;
+}
+
+/**
+ * @brief 将整个字符串解析为非负十进制整数。
+ *
+ * @param text 待解析的字符串。
+ * @param value 解析结果。
+ * @return 字符串为空、含有非数字字符或超出范围时返回 false。
+ */
+bool ParseUnsigned(const char *text, std::uint64_t &value)
+{
+    if (*text < '0' || *text > '9')
+        return false;
+    errno = 0;
+    char *end = nullptr;
+    value = std::strtoull(text, &end, 10);
+    return errno == 0 && *end == '\0';
+}
+
+/**
+ * @brief 生成可复现的合成点云并写入 PLY 文件，用于规模测试。
+ *
+ * 相同的形状、点数和种子总是生成完全相同的文件，与线程数和块大小无关。
+ *
+ * @return 0 表示成功，1 表示参数错误或写入失败。
+ */
+int main(int argc, char *argv[])
+{
+    if (argc < 4)
+    {
+        PrintUsage();
+        return 1;
+    }
+    std::string shape = argv[1];
+    std::uint64_t count = 0;
+    std::string output = argv[3];
+    std::uint64_t seed = 0;
+    std::uint64_t threads = 0;
+    std::uint64_t chunk = 1 << 20;
+    if (!ParseUnsigned(argv[2], count) || count == 0)
+    {
+        std::cerr << "Invalid point count: " << argv[2] << std::endl;
+        PrintUsage();
+        return 1;
+    }
+    for (int i = 4; i < argc; i += 2)
+    {
+        bool valid = i + 1 < argc;
+        if (valid && std::strcmp(argv[i], "--seed") == 0)
+            valid = ParseUnsigned(argv[i + 1], seed);
+        else if (valid && std::strcmp(argv[i], "--threads") == 0)
+            valid = ParseUnsigned(argv[i + 1], threads) && threads <= 4096;
+        else if (valid && std::strcmp(argv[i], "--chunk") == 0)
+            valid = ParseUnsigned(argv[i + 1], chunk) && chunk > 0;
+        else
+            valid = false;
+
+        if (!valid)
+        {
+            std::cerr << "Invalid option: " << argv[i] << (i + 1 < argc ? std::string(" ") + argv[i + 1] : "")
+                      << std::endl;
+            PrintUsage();
+            return 1;
+        }
+    }
+
+    unsigned worker_threads = static_cast<unsigned>(threads);
+
+    auto start = std::chrono::steady_clock::now();
+    bool ok = false;
+    if (shape == "clusters")
+    {
+        GaussianClusters clusters;
+        clusters.centers = {{-3, -3, -3}, {3, 3, 3}, {-3, 3, -3}, {3, -3, 3}};
+        clusters.seed = seed;
+        ok = WritePointCloudPLY(output, count, [&](std::uint64_t i, double p[3])
+                                { clusters.point(i, p); }, worker_threads, chunk);
+    }
+    else if (shape == "plane")
+    {
+        PlaneCloud plane;
+        plane.halfU = plane.halfV = 10.0;
+        plane.noise = 0.01;
+        plane.seed = seed;
+        ok = WritePointCloudPLY(output, count, [&](std::uint64_t i, double p[3])
+                                { plane.point(i, p); }, worker_threads, chunk);
+    }
+    else if (shape == "surface")
+    {
+        NoisySurface surface;
+        surface.seed = seed;
+        ok = WritePointCloudPLY(output, count, [&](std::uint64_t i, double p[3])
+                                { surface.point(i, p); }, worker_threads, chunk);
+    }
+    else if (shape == "pair")
+    {
+        // 与 main.cpp 中的浮动数据一致：绕 X 轴旋转10度并平移 (0.2, 0.1, 0.1)
+        KnownTransformPair<NoisySurface> pair;
+        pair.shape.seed = seed;
+        pair.axis = {1, 0, 0};
+        pair.angle = 10.0 * 3.141592653589793 / 180.0;
+        pair.translation = {0.2, 0.1, 0.1};
+        pair.noise = 0.005;
+        pair.seed = seed;
+        ok = WritePointCloudPLY(output + ".source.ply", count, [&](std::uint64_t i, double p[3])
+                                { pair.source(i, p); }, worker_threads, chunk) &&
+             WritePointCloudPLY(output + ".target.ply", count, [&](std::uint64_t i, double p[3])
+                                { pair.target(i, p); }, worker_threads, chunk);
+
+        std::ofstream gt(output + ".gt.txt");
+        std::array<double, 16> m = pair.groundTruth();
+        gt.precision(17);
+        for (int r = 0; r < 4; ++r)
+            gt << m[4 * r] << " " << m[4 * r + 1] << " " << m[4 * r + 2] << " " << m[4 * r + 3] << "\n";
+        ok = ok && static_cast<bool>(gt);
+    }
+    else
+    {
+        PrintUsage();
+        return 1;
+    }
+
+    if (!ok)
+    {
+        std::cerr << "Failed to write " << output << std::endl;
+        return 1;
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "Generated " << count << " points in " << seconds << " s ("
+              << count / seconds / 1e6 << " Mpts/s)" << std::endl;
+    return 0;
+}
@@ -0,0 +1,313 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Philox4x32-10 计数器随机数生成器。
+ *
+ * 输出完全由 (计数器, 密钥) 决定，不保存内部状态，因此任意下标的随机数
+ * 都可以在任意线程上独立生成，结果与生成顺序和线程数无关。
+ */
+class Philox4x32
+{
+public:
+    using Counter = std::array<std::uint32_t, 4>;
+    using Key = std::array<std::uint32_t, 2>;
+
+    /**
+     * @brief 对一个计数器做10轮 Philox 变换。
+     *
+     * @param ctr 计数器。
+     * @param key 密钥。
+     * @return 4个32位随机数。
+     */
+    static Counter generate(Counter ctr, Key key)
+    {
+        for (int round = 0; round < 10; ++round)
+        {
+            std::uint64_t p0 = static_cast<std::uint64_t>(0xD2511F53u) * ctr[0];
+            std::uint64_t p1 = static_cast<std::uint64_t>(0xCD9E8D57u) * ctr[2];
+            ctr = {static_cast<std::uint32_t>(p1 >> 32) ^ ctr[1] ^ key[0],
+                   static_cast<std::uint32_t>(p1),
+                   static_cast<std::uint32_t>(p0 >> 32) ^ ctr[3] ^ key[1],
+                   static_cast<std::uint32_t>(p0)};
+            key[0] += 0x9E3779B9u;
+            key[1] += 0xBB67AE85u;
+        }
+        return ctr;
+    }
+};
+
+/**
+ * @brief 基于 Philox 的随机数流，由种子和流编号确定。
+ *
+ * 同一种子下不同的流编号互不相关，可为同一个点的不同用途（位置、噪声等）
+ * 分配不同的流。
+ */
+class CounterRng
+{
+private:
+    Philox4x32::Key key;
+    std::uint32_t stream;
+
+public:
+    CounterRng(std::uint64_t seed, std::uint32_t stream_id = 0)
+        : key{static_cast<std::uint32_t>(seed), static_cast<std::uint32_t>(seed >> 32)},
+          stream(stream_id) {}
+
+    /**
+     * @brief 第 index 个元素的第 block 组均匀分布随机数，范围 (0, 1)。
+     */
+    std::array<double, 4> uniform(std::uint64_t index, std::uint32_t block = 0) const
+    {
+        Philox4x32::Counter ctr = {static_cast<std::uint32_t>(index),
+                                   static_cast<std::uint32_t>(index >> 32),
+                                   stream,
+                                   block};
+        Philox4x32::Counter r = Philox4x32::generate(ctr, key);
+        std::array<double, 4> u;
+        for (int i = 0; i < 4; ++i)
+            u[i] = (static_cast<double>(r[i]) + 0.5) * (1.0 / 4294967296.0);
+        return u;
+    }
+
+    /**
+     * @brief 第 index 个元素的第 block 组标准正态分布随机数（Box-Muller）。
+     */
+    std::array<double, 4> normal(std::uint64_t index, std::uint32_t block = 0) const
+    {
+        const double two_pi = 6.283185307179586;
+        std::array<double, 4> u = uniform(index, block);
+        double r0 = std::sqrt(-2.0 * std::log(u[0]));
+        double r1 = std::sqrt(-2.0 * std::log(u[2]));
+        return {r0 * std::cos(two_pi * u[1]), r0 * std::sin(two_pi * u[1]),
+                r1 * std::cos(two_pi * u[3]), r1 * std::sin(two_pi * u[3])};
+    }
+};
+
+/**
+ * @brief 高斯聚类点云：第 i 个点属于第 i % centers.size() 个聚类。
+ */
+struct GaussianClusters
+{
+    std::vector<std::array<double, 3>> centers;
+    double stddev = 1.0;
+    std::uint64_t seed = 0;
+
+    void point(std::uint64_t i, double p[3]) const
+    {
+        const auto &c = centers[i % centers.size()];
+        std::array<double, 4> n = CounterRng(seed).normal(i);
+        for (int k = 0; k < 3; ++k)
+            p[k] = c[k] + stddev * n[k];
+    }
+};
+
+/**
+ * @brief 平面上均匀分布的点，沿法向叠加高斯噪声。
+ *
+ * axisU、axisV 需为两两正交的单位向量，平面大小为 2*halfU x 2*halfV。
+ */
+struct PlaneCloud
+{
+    std::array<double, 3> origin = {0, 0, 0};
+    std::array<double, 3> axisU = {1, 0, 0};
+    std::array<double, 3> axisV = {0, 1, 0};
+    double halfU = 1.0;
+    double halfV = 1.0;
+    double noise = 0.0;
+    std::uint64_t seed = 0;
+
+    void point(std::uint64_t i, double p[3]) const
+    {
+        std::array<double, 4> u = CounterRng(seed).uniform(i);
+        double n = noise * CounterRng(seed, 1).normal(i)[0];
+        double a = (2.0 * u[0] - 1.0) * halfU;
+        double b = (2.0 * u[1] - 1.0) * halfV;
+        std::array<double, 3> normal = {axisU[1] * axisV[2] - axisU[2] * axisV[1],
+                                        axisU[2] * axisV[0] - axisU[0] * axisV[2],
+                                        axisU[0] * axisV[1] - axisU[1] * axisV[0]};
+        for (int k = 0; k < 3; ++k)
+            p[k] = origin[k] + a * axisU[k] + b * axisV[k] + n * normal[k];
+    }
+};
+
+/**
+ * @brief 起伏曲面 z = amplitude * sin(frequency * x) * cos(frequency * y)，叠加各向同性高斯噪声。
+ *
+ * x、y 在 [-extent, extent] 内均匀分布。
+ */
+struct NoisySurface
+{
+    double extent = 1.0;
+    double amplitude = 0.3;
+    double frequency = 3.0;
+    double noise = 0.01;
+    std::uint64_t seed = 0;
+
+    void point(std::uint64_t i, double p[3]) const
+    {
+        std::array<double, 4> u = CounterRng(seed).uniform(i);
+        std::array<double, 4> n = CounterRng(seed, 1).normal(i);
+        double x = (2.0 * u[0] - 1.0) * extent;
+        double y = (2.0 * u[1] - 1.0) * extent;
+        p[0] = x + noise * n[0];
+        p[1] = y + noise * n[1];
+        p[2] = amplitude * std::sin(frequency * x) * std::cos(frequency * y) + noise * n[2];
+    }
+};
+
+/**
+ * @brief 已知真值变换的点云对：target = R * source + t，再叠加独立噪声。
+ *
+ * 源点和目标点由同一个基础形状生成，第 i 个源点与第 i 个目标点一一对应，
+ * 可直接用于评估配准精度。
+ */
+template <typename Shape>
+struct KnownTransformPair
+{
+    Shape shape;
+    std::array<double, 3> axis = {0, 0, 1}; // 旋转轴（单位向量）
+    double angle = 0.0;                     // 旋转角（弧度）
+    std::array<double, 3> translation = {0, 0, 0};
+    double noise = 0.0;
+    std::uint64_t seed = 0;
+
+    void source(std::uint64_t i, double p[3]) const
+    {
+        shape.point(i, p);
+    }
+
+    void target(std::uint64_t i, double p[3]) const
+    {
+        double s[3];
+        shape.point(i, s);
+        std::array<double, 16> m = groundTruth();
+        std::array<double, 4> n = CounterRng(seed, 2).normal(i);
+        for (int r = 0; r < 3; ++r)
+            p[r] = m[4 * r] * s[0] + m[4 * r + 1] * s[1] + m[4 * r + 2] * s[2] + m[4 * r + 3] + noise * n[r];
+    }
+
+    /**
+     * @brief 由轴角和平移得到的4x4真值变换矩阵（行主序）。
+     */
+    std::array<double, 16> groundTruth() const
+    {
+        double c = std::cos(angle), s = std::sin(angle), t = 1.0 - c;
+        double x = axis[0], y = axis[1], z = axis[2];
+        return {t * x * x + c, t * x * y - s * z, t * x * z + s * y, translation[0],
+                t * x * y + s * z, t * y * y + c, t * y * z - s * x, translation[1],
+                t * x * z - s * y, t * y * z + s * x, t * z * z + c, translation[2],
+                0.0, 0.0, 0.0, 1.0};
+    }
+};
+
+/**
+ * @brief 将 [0, count) 按 chunk_size 分块，由 threads 个线程并行处理。
+ *
+ * 线程从共享计数器中领取块，块的划分与线程数无关。
+ *
+ * @param count 元素总数。
+ * @param chunk_size 每块的元素数。
+ * @param threads 线程数，0 表示使用 CPU 核数。
+ * @param func 处理函数 func(begin, end)。
+ */
+template <typename Func>
+void ParallelChunks(std::uint64_t count, std::uint64_t chunk_size, unsigned threads, Func func)
+{
+    if (threads == 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    chunk_size = std::max<std::uint64_t>(chunk_size, 1);
+    std::uint64_t chunks = (count + chunk_size - 1) / chunk_size;
+
+    std::atomic<std::uint64_t> next(0);
+    auto worker = [&]
+    {
+        for (std::uint64_t c = next++; c < chunks; c = next++)
+        {
+            std::uint64_t begin = c * chunk_size;
+            func(begin, std::min(begin + chunk_size, count));
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (unsigned t = 1; t < threads; ++t)
+        pool.emplace_back(worker);
+    worker();
+    for (auto &thread : pool)
+        thread.join();
+}
+
+/**
+ * @brief 并行生成点云并以二进制 PLY（float32 x y z）流式写入文件。
+ *
+ * 每个点在文件中的位置固定，各线程生成一块后直接写到对应偏移处，
+ * 内存占用只与线程数和块大小有关，与点数无关。
+ *
+ * @param path 输出文件路径。
+ * @param count 点数。
+ * @param point_func 点生成函数 point_func(i, p)。
+ * @param threads 线程数，0 表示使用 CPU 核数。
+ * @param chunk_size 每块的点数。
+ * @return 写入成功返回 true。
+ */
+template <typename PointFunc>
+bool WritePointCloudPLY(const std::string &path,
+                        std::uint64_t count,
+                        PointFunc point_func,
+                        unsigned threads = 0,
+                        std::uint64_t chunk_size = 1 << 20)
+{
+    std::ostringstream header;
+    header << "ply\nformat binary_little_endian 1.0\n"
+           << "element vertex " << count << "\n"
+           << "property float x\nproperty float y\nproperty float z\n"
+           << "end_header\n";
+    const std::string header_text = header.str();
+    const std::uint64_t point_bytes = 3 * sizeof(float);
+
+    {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        if (!out.write(header_text.data(), header_text.size()))
+            return false;
+    }
+
+    std::atomic<bool> ok(true);
+    ParallelChunks(count, chunk_size, threads, [&](std::uint64_t begin, std::uint64_t end)
+                   {
+        if (!ok)
+            return;
+
+        // 按小端序逐字节写出，与主机字节序无关
+        std::vector<unsigned char> buffer((end - begin) * point_bytes);
+        unsigned char *dst = buffer.data();
+        for (std::uint64_t i = begin; i < end; ++i)
+        {
+            double p[3];
+            point_func(i, p);
+            for (int k = 0; k < 3; ++k)
+            {
+                float f = static_cast<float>(p[k]);
+                std::uint32_t bits;
+                std::memcpy(&bits, &f, sizeof(bits));
+                for (int b = 0; b < 4; ++b)
+                    *dst++ = static_cast<unsigned char>(bits >> (8 * b));
+            }
+        }
+
+        std::ofstream out(path, std::ios::binary | std::ios::in | std::ios::out);
+        out.seekp(static_cast<std::streamoff>(header_text.size() + begin * point_bytes));
+        if (!out.write(reinterpret_cast<const char *>(buffer.data()), buffer.size()))
+            ok = false; });
+    return ok;
+}